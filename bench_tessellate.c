@@ -0,0 +1,72 @@
+/* bench_tessellate.c - Time tess_build against worker count
+ *
+ * Usage: bench_tessellate [workers...]   (default: 1 2 4 8)
+ *
+ * Tessellates 10k random patches at GRID 20 and checks that every worker
+ * count produces a mesh byte-identical to the single-worker build.
+ */
+
+#include "tessellate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NPATCHES 10000
+#define GRID 20
+#define RUNS 5
+
+static BezierPatch patches[NPATCHES];
+static TessContext ref, ctx;
+
+static double now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Best of RUNS rebuilds, after one build to size arenas and output buffers
+static double time_build(TessContext *c) {
+    double best = 1e30;
+    tess_build(c, patches, NPATCHES);
+    for (int r = 0; r < RUNS; r++) {
+        double t0 = now();
+        tess_build(c, patches, NPATCHES);
+        double ms = (now() - t0) * 1e3;
+        if (ms < best) best = ms;
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    int defaults[] = {1, 2, 4, 8};
+    int nruns = argc > 1 ? argc - 1 : 4;
+
+    srand(1);
+    for (int p = 0; p < NPATCHES; p++)
+        for (int i = 0; i < 4; i++) for (int j = 0; j < 4; j++)
+            patches[p].ctrl[i][j] = (Vec3){ rand() / (float)RAND_MAX,
+                                            rand() / (float)RAND_MAX,
+                                            rand() / (float)RAND_MAX };
+
+    tess_init(&ref, GRID, 1);
+    double base = time_build(&ref);
+    printf("%d patches, grid %d: %zu vertices, %zu indices\n",
+           NPATCHES, GRID, ref.nverts, ref.nindices);
+    printf("workers  ms/build  speedup  identical\n");
+
+    int failed = 0;
+    for (int k = 0; k < nruns; k++) {
+        int n = argc > 1 ? atoi(argv[k + 1]) : defaults[k];
+        tess_init(&ctx, GRID, n);
+        double ms = time_build(&ctx);
+        int same = ctx.nverts == ref.nverts && ctx.nindices == ref.nindices &&
+                   !memcmp(ctx.verts, ref.verts, ref.nverts * sizeof(Vec3)) &&
+                   !memcmp(ctx.indices, ref.indices, ref.nindices * sizeof(unsigned int));
+        printf("%7d  %8.1f  %7.2f  %s\n", ctx.nworkers, ms, base / ms, same ? "yes" : "NO");
+        failed |= !same;
+        tess_free(&ctx);
+    }
+    tess_free(&ref);
+    return failed;
+}
@@ -0,0 +1,213 @@
+/* tessellate.c - Parallel Bezier patch tessellation (see tessellate.h) */
+
+#include "tessellate.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define ARENA_ALIGN 64
+
+typedef struct {
+    TessContext *ctx;
+    const BezierPatch *patches;
+    pthread_barrier_t *barrier;
+    int worker, nworkers;
+} TessWorker;
+
+static void *grow(void *p, size_t bytes) {
+    void *q = realloc(p, bytes);
+    if (!q) {
+        fprintf(stderr, "tessellate: out of memory (%zu bytes)\n", bytes);
+        exit(1);
+    }
+    return q;
+}
+
+// For arenas and the job array: keeps workers' data on separate cache lines
+static void *alloc_aligned(size_t bytes) {
+    void *p = NULL;
+    if (posix_memalign(&p, ARENA_ALIGN, bytes) != 0) {
+        fprintf(stderr, "tessellate: out of memory (%zu bytes)\n", bytes);
+        exit(1);
+    }
+    return p;
+}
+
+static void *arena_alloc(TessArena *a, size_t bytes) {
+    size_t off = (a->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    a->used = off + bytes;
+    return a->base + off;
+}
+
+static size_t arena_need(size_t nverts, size_t nindices) {
+    return nverts * sizeof(Vec3) + nindices * sizeof(unsigned int) + 2 * ARENA_ALIGN;
+}
+
+static void tessellate_patch(const BezierPatch *patch, const float *basis, int grid,
+                             Vec3 *verts, unsigned int *indices, unsigned int base) {
+    int n = grid + 1;
+    for (int i = 0; i <= grid; i++) {
+        const float *bu = basis + i * 4;
+        for (int j = 0; j <= grid; j++) {
+            const float *bv = basis + j * 4;
+            Vec3 sum = {0};
+            for (int a = 0; a < 4; a++) for (int b = 0; b < 4; b++) {
+                float w = bu[a] * bv[b];
+                sum.x += w * patch->ctrl[a][b].x;
+                sum.y += w * patch->ctrl[a][b].y;
+                sum.z += w * patch->ctrl[a][b].z;
+            }
+            *verts++ = sum;
+        }
+    }
+    for (int i = 0; i < grid; i++) for (int j = 0; j < grid; j++) {
+        unsigned int p00 = base + i * n + j;
+        unsigned int p10 = p00 + n;
+        unsigned int p01 = p00 + 1;
+        unsigned int p11 = p10 + 1;
+        *indices++ = p00; *indices++ = p10; *indices++ = p11;
+        *indices++ = p00; *indices++ = p11; *indices++ = p01;
+    }
+}
+
+static void merge_offsets(TessContext *ctx) {
+    size_t v = 0, k = 0;
+    for (int j = 0; j < ctx->njobs; j++) {
+        ctx->jobs[j].vert_off = v;
+        ctx->jobs[j].index_off = k;
+        v += ctx->jobs[j].nverts;
+        k += ctx->jobs[j].nindices;
+    }
+    if (v > ctx->verts_cap) {
+        ctx->verts = grow(ctx->verts, v * sizeof(Vec3));
+        ctx->verts_cap = v;
+    }
+    if (k > ctx->indices_cap) {
+        ctx->indices = grow(ctx->indices, k * sizeof(unsigned int));
+        ctx->indices_cap = k;
+    }
+    ctx->nverts = v;
+    ctx->nindices = k;
+}
+
+static void *tess_worker(void *arg) {
+    TessWorker *w = arg;
+    TessContext *ctx = w->ctx;
+    TessArena *arena = &ctx->arena[w->worker];
+    int grid = ctx->grid;
+    size_t vpp = (size_t)(grid + 1) * (grid + 1);
+    size_t ipp = (size_t)grid * grid * 6;
+
+    // Phase 1: tessellate this worker's batches into its own arena.
+    arena->used = 0;
+    for (int j = w->worker; j < ctx->njobs; j += w->nworkers) {
+        TessJob *job = &ctx->jobs[j];
+        job->nverts = job->npatches * vpp;
+        job->nindices = job->npatches * ipp;
+        job->verts = arena_alloc(arena, job->nverts * sizeof(Vec3));
+        job->indices = arena_alloc(arena, job->nindices * sizeof(unsigned int));
+        for (int p = 0; p < job->npatches; p++)
+            tessellate_patch(&w->patches[job->first_patch + p], ctx->basis, grid,
+                             job->verts + p * vpp, job->indices + p * ipp,
+                             (unsigned int)(p * vpp));
+    }
+
+    // Phase 2: one thread lays out the merged mesh in patch order.
+    if (pthread_barrier_wait(w->barrier) == PTHREAD_BARRIER_SERIAL_THREAD)
+        merge_offsets(ctx);
+    pthread_barrier_wait(w->barrier);
+
+    // Phase 3: copy our batches into place, rebasing indices.
+    for (int j = w->worker; j < ctx->njobs; j += w->nworkers) {
+        TessJob *job = &ctx->jobs[j];
+        unsigned int base = (unsigned int)job->vert_off;
+        unsigned int *dst = ctx->indices + job->index_off;
+        memcpy(ctx->verts + job->vert_off, job->verts, job->nverts * sizeof(Vec3));
+        for (size_t k = 0; k < job->nindices; k++)
+            dst[k] = job->indices[k] + base;
+    }
+    return NULL;
+}
+
+void tess_init(TessContext *ctx, int grid, int nworkers) {
+    memset(ctx, 0, sizeof(*ctx));
+    if (nworkers <= 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        nworkers = n > 0 ? (int)n : 1;
+    }
+    if (nworkers > TESS_MAX_WORKERS) nworkers = TESS_MAX_WORKERS;
+    ctx->grid = grid;
+    ctx->nworkers = nworkers;
+
+    ctx->basis = grow(NULL, (grid + 1) * 4 * sizeof(float));
+    for (int i = 0; i <= grid; i++) {
+        float t = (float)i / grid, s = 1 - t;
+        ctx->basis[i*4 + 0] = s * s * s;
+        ctx->basis[i*4 + 1] = 3 * t * s * s;
+        ctx->basis[i*4 + 2] = 3 * t * t * s;
+        ctx->basis[i*4 + 3] = t * t * t;
+    }
+}
+
+void tess_free(TessContext *ctx) {
+    for (int i = 0; i < TESS_MAX_WORKERS; i++)
+        free(ctx->arena[i].base);
+    free(ctx->basis);
+    free(ctx->jobs);
+    free(ctx->verts);
+    free(ctx->indices);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void tess_build(TessContext *ctx, const BezierPatch *patches, int npatches) {
+    int grid = ctx->grid;
+    int njobs = (npatches + TESS_BATCH - 1) / TESS_BATCH;
+    int nworkers = ctx->nworkers;
+    if (nworkers > njobs) nworkers = njobs > 0 ? njobs : 1;
+
+    // Job records are rewritten below, so growing needs no copy
+    if (njobs > ctx->jobs_cap) {
+        free(ctx->jobs);
+        ctx->jobs = alloc_aligned(njobs * sizeof(TessJob));
+        ctx->jobs_cap = njobs;
+    }
+    for (int j = 0; j < njobs; j++) {
+        ctx->jobs[j].first_patch = j * TESS_BATCH;
+        ctx->jobs[j].npatches = (j == njobs - 1) ? npatches - j * TESS_BATCH : TESS_BATCH;
+    }
+    ctx->njobs = njobs;
+
+    // Size every arena for the batches it will receive, so workers never
+    // allocate. Arenas keep their memory between rebuilds.
+    size_t vpp = (size_t)(grid + 1) * (grid + 1);
+    size_t ipp = (size_t)grid * grid * 6;
+    for (int wk = 0; wk < nworkers; wk++) {
+        size_t need = 0;
+        for (int j = wk; j < njobs; j += nworkers)
+            need += arena_need(ctx->jobs[j].npatches * vpp, ctx->jobs[j].npatches * ipp);
+        if (need > ctx->arena[wk].cap) {
+            free(ctx->arena[wk].base);
+            ctx->arena[wk].base = alloc_aligned(need);
+            ctx->arena[wk].cap = need;
+        }
+    }
+
+    // The calling thread acts as worker 0.
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, nworkers);
+    TessWorker workers[TESS_MAX_WORKERS];
+    pthread_t threads[TESS_MAX_WORKERS];
+    for (int wk = 0; wk < nworkers; wk++) {
+        workers[wk] = (TessWorker){ ctx, patches, &barrier, wk, nworkers };
+        if (wk > 0 && pthread_create(&threads[wk], NULL, tess_worker, &workers[wk]) != 0) {
+            fprintf(stderr, "tessellate: cannot start worker %d\n", wk);
+            exit(1);
+        }
+    }
+    tess_worker(&workers[0]);
+    for (int wk = 1; wk < nworkers; wk++)
+        pthread_join(threads[wk], NULL);
+    pthread_barrier_destroy(&barrier);
+}
@@ -0,0 +1,65 @@
+/* tessellate.h - Parallel Bezier patch tessellation
+ *
+ * Patches are split into fixed-size batches and handed round-robin to a
+ * set of workers. Each worker writes its vertices and indices into its own
+ * bump arena, then the batches are copied into one contiguous mesh in patch
+ * order, so the result does not depend on the number of workers.
+ *
+ * Workers are started and joined inside each tess_build call rather than
+ * kept in a pool: rebuilds only happen when the patches change, and the
+ * thread start-up is small next to tessellating a large model.
+ */
+
+#ifndef TESSELLATE_H
+#define TESSELLATE_H
+
+#include <stddef.h>
+
+typedef struct { float x, y, z; } Vec3;
+typedef struct { Vec3 ctrl[4][4]; } BezierPatch;
+
+#define TESS_MAX_WORKERS 64
+#define TESS_BATCH 32       // patches per job
+
+// Bump allocator owned by a single worker. Reset on every rebuild and only
+// grown (by the main thread) when a rebuild needs more room than before.
+typedef struct {
+    _Alignas(64) char *base;
+    size_t used, cap;
+} TessArena;
+
+typedef struct {
+    _Alignas(64) int first_patch;
+    int npatches;
+    Vec3 *verts;            // in the owning worker's arena
+    unsigned int *indices;  // local to the batch, rebased on merge
+    size_t nverts, nindices;
+    size_t vert_off, index_off;  // destination in the merged mesh
+} TessJob;
+
+// Embeds 64-byte aligned arenas: declare it static or automatic, or use
+// aligned_alloc(64, ...) if it has to live on the heap.
+typedef struct {
+    int grid;               // quads per patch side
+    int nworkers;
+    float *basis;           // (grid+1) x 4 Bernstein weights
+    TessArena arena[TESS_MAX_WORKERS];
+
+    TessJob *jobs;
+    int njobs, jobs_cap;
+
+    // Merged output: patch p owns (grid+1)^2 vertices starting at
+    // p * (grid+1)^2, laid out row by row in u. Each quad is emitted as the
+    // triangles (p00, p10, p11) and (p00, p11, p01).
+    Vec3 *verts;
+    unsigned int *indices;
+    size_t nverts, nindices;
+    size_t verts_cap, indices_cap;
+} TessContext;
+
+// nworkers <= 0 picks the number of online cores.
+void tess_init(TessContext *ctx, int grid, int nworkers);
+void tess_free(TessContext *ctx);
+void tess_build(TessContext *ctx, const BezierPatch *patches, int npatches);
+
+#endif
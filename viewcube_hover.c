@@ -6,7 +6,7 @@
  * - Highlight face/edge/corner on mouse hover
  * - Click to rotate
  * - Smooth animation (disabled)
- * - Face/edge/corner click detection
+ * - Face/edge/corner click detection via an item-ID buffer (viewcube_pick.c)
  */
 
 #include <X11/Intrinsic.h>
@@ -18,6 +18,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
+#include "viewcube_pick.h"
 
 #define DEG2RAD(d) ((d) * M_PI / 180.0)
 #define TIMER_INTERVAL 20 // ms
@@ -29,28 +30,17 @@ static int buffer_height = 0;
 // ========================= 3D Cube Geometry =============================
 
 typedef struct { double x, y, z; } Vec3;
-typedef struct { int v[4]; char *label; Vec3 normal; } Face;
-
-Vec3 cube_vertices[8] = {
-    {-1, -1, -1}, {+1, -1, -1}, {+1, +1, -1}, {-1, +1, -1},
-    {-1, -1, +1}, {+1, -1, +1}, {+1, +1, +1}, {-1, +1, +1}
-};
+typedef struct { char *label; Vec3 normal; } Face;  // vertices in vc_cube_faces
 
 Face cube_faces[6] = {
-    {{0,1,2,3}, "下", { 0,  0, -1}},
-    {{4,5,6,7}, "上", { 0,  0, +1}},
-    {{0,4,7,3}, "左", {-1,  0,  0}},
-    {{1,5,6,2}, "右", {+1,  0,  0}},
-    {{0,1,5,4}, "前", { 0, -1,  0}},
-    {{3,2,6,7}, "後", { 0, +1,  0}}
-};
-
-int cube_edges[12][2] = {
-    {0,1},{1,2},{2,3},{3,0}, {4,5},{5,6},{6,7},{7,4}, {0,4},{1,5},{2,6},{3,7}
+    {"下", { 0,  0, -1}},
+    {"上", { 0,  0, +1}},
+    {"左", {-1,  0,  0}},
+    {"右", {+1,  0,  0}},
+    {"前", { 0, -1,  0}},
+    {"後", { 0, +1,  0}}
 };
 
-int cube_corners[8] = {0,1,2,3,4,5,6,7};
-
 // ======================= Vector Math ====================================
 
 Vec3 rotate(Vec3 v, double ax, double ay, double az) {
@@ -118,53 +108,61 @@ static double angle_y = DEG2RAD(45);
 static double target_ax = DEG2RAD(35.264);
 static double target_ay = DEG2RAD(45);
 static int hover_face = -1, hover_edge = -1, hover_corner = -1;
+static int hover_id = VC_PICK_NONE;
+static VcPickBuffer pick;
 static Widget global_widget;
 
 void draw_cube(Display *dpy, Drawable drawable, GC gc, Visual *visual, int screen,
                int width, int height, int mouse_x, int mouse_y){
     Vec3 rotated[8];
-    for (int i = 0; i < 8; i++)
-        rotated[i] = rotate(cube_vertices[i], angle_x, angle_y, 0);
+    for (int i = 0; i < 8; i++) {
+        Vec3 v = { vc_cube_vertices[i][0], vc_cube_vertices[i][1], vc_cube_vertices[i][2] };
+        rotated[i] = rotate(v, angle_x, angle_y, 0);
+    }
 
     Vec2 projected[8];
     for (int i = 0; i < 8; i++)
         projected[i] = project(rotated[i], width, height, 60);
 
-    hover_face = hover_edge = hover_corner = -1;
-
-    for (int i = 0; i < 8; i++) {
-        int dx = projected[i].x - mouse_x, dy = projected[i].y - mouse_y;
-        if (dx*dx + dy*dy < 10*10) hover_corner = i;
+    // The ID buffer only changes with the view angles
+    if (vc_pick_stale(&pick, angle_x, angle_y, 0)) {
+        VcPickVertex pv[8];
+        for (int i = 0; i < 8; i++)
+            pv[i] = (VcPickVertex){ width/2 + rotated[i].x * 60,
+                                    height/2 - rotated[i].y * 60, rotated[i].z };
+        vc_pick_render(&pick, pv, angle_x, angle_y, 0);
     }
 
-    for (int i = 0; i < 12; i++) {
-        int x1 = projected[cube_edges[i][0]].x, y1 = projected[cube_edges[i][0]].y;
-        int x2 = projected[cube_edges[i][1]].x, y2 = projected[cube_edges[i][1]].y;
-        int mx = (x1 + x2) / 2, my = (y1 + y2) / 2;
-        int dx = mx - mouse_x, dy = my - mouse_y;
-        if (dx*dx + dy*dy < 10*10) hover_edge = i;
-    }
+    hover_id = vc_pick_lookup(&pick, mouse_x, mouse_y);
+    hover_face = VC_PICK_IS_FACE(hover_id) ? hover_id - VC_PICK_FACE : -1;
+    hover_edge = VC_PICK_IS_EDGE(hover_id) ? hover_id - VC_PICK_EDGE : -1;
+    hover_corner = VC_PICK_IS_CORNER(hover_id) ? hover_id - VC_PICK_CORNER : -1;
+
+    // Hidden faces are skipped, so clear what the last frame drew
+    Pixel bg;
+    XtVaGetValues(global_widget, XmNbackground, &bg, NULL);
+    XSetForeground(dpy, gc, bg);
+    XFillRectangle(dpy, drawable, gc, 0, 0, width, height);
 
     for (int f = 0; f < 6; f++) {
+        if (!pick.face_visible[f]) continue;
         Face face = cube_faces[f];
+        const int *fv = vc_cube_faces[f];
         Vec3 center = {0,0,0};
         for (int i = 0; i < 4; i++) {
-            center.x += rotated[face.v[i]].x;
-            center.y += rotated[face.v[i]].y;
-            center.z += rotated[face.v[i]].z;
+            center.x += rotated[fv[i]].x;
+            center.y += rotated[fv[i]].y;
+            center.z += rotated[fv[i]].z;
         }
         center.x /= 4; center.y /= 4; center.z /= 4;
 
         Vec2 c = project(center, width, height, 60);
-        int dx = c.x - mouse_x, dy = c.y - mouse_y;
-        int dist2 = dx*dx + dy*dy;
-        if (dist2 < 20*20) hover_face = f;
 
         XSetForeground(dpy, gc, (f == hover_face) ? 0xff0000 : 0xcccccc);
         XPoint pts[5];
         for (int i = 0; i < 4; i++) {
-            pts[i].x = projected[face.v[i]].x;
-            pts[i].y = projected[face.v[i]].y;
+            pts[i].x = projected[fv[i]].x;
+            pts[i].y = projected[fv[i]].y;
         }
         pts[4] = pts[0];
         XFillPolygon(dpy, drawable, gc, pts, 4, Convex, CoordModeOrigin);
@@ -179,11 +177,12 @@ void draw_cube(Display *dpy, Drawable drawable, GC gc, Visual *visual, int scree
     }
 
     for (int i = 0; i < 12; i++) {
+        if (!pick.edge_visible[i]) continue;
         int color = (i == hover_edge) ? 0x00aa00 : 0x000000;
         XSetForeground(dpy, gc, color);
         XDrawLine(dpy, drawable, gc,
-            projected[cube_edges[i][0]].x, projected[cube_edges[i][0]].y,
-            projected[cube_edges[i][1]].x, projected[cube_edges[i][1]].y);
+            projected[vc_cube_edges[i][0]].x, projected[vc_cube_edges[i][0]].y,
+            projected[vc_cube_edges[i][1]].x, projected[vc_cube_edges[i][1]].y);
     }
 
     if (hover_corner >= 0) {
@@ -227,6 +226,10 @@ void motion_cb(Widget w, XtPointer client_data, XEvent *event, Boolean *cont) {
         back_buffer = XCreatePixmap(dpy, win, width, height, DefaultDepth(dpy, screen));
         buffer_width = width;
         buffer_height = height;
+        vc_pick_resize(&pick, 0, 0, width, height);
+    } else if (!vc_pick_stale(&pick, angle_x, angle_y, 0) &&
+               vc_pick_lookup(&pick, e->x, e->y) == hover_id) {
+        return;  // same item under the pointer, nothing to redraw
     }
 
     draw_cube(dpy, back_buffer, gc, visual, screen, width, height, mouse_xy[0], mouse_xy[1]);
@@ -261,6 +264,7 @@ int main(int argc, char *argv[]) {
         XmNwidth, 300, XmNheight, 300, NULL);
 
     global_widget = drawing;
+    vc_pick_init(&pick, 6, 9);
     static int mouse_xy[2] = {150, 150};
     XtAddCallback(drawing, XmNexposeCallback, expose_cb, mouse_xy);
     XtAddEventHandler(drawing, PointerMotionMask, False, motion_cb, mouse_xy);
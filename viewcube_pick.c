@@ -0,0 +1,154 @@
+/* viewcube_pick.c - Item-ID buffer for ViewCube picking (see viewcube_pick.h) */
+
+#include "viewcube_pick.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+const float vc_cube_vertices[8][3] = {
+    {-1, -1, -1}, {+1, -1, -1}, {+1, +1, -1}, {-1, +1, -1},
+    {-1, -1, +1}, {+1, -1, +1}, {+1, +1, +1}, {-1, +1, +1}
+};
+
+const int vc_cube_faces[6][4] = {
+    {0,1,2,3}, {4,5,6,7}, {0,4,7,3}, {1,5,6,2}, {0,1,5,4}, {3,2,6,7}
+};
+
+const int vc_cube_edges[12][2] = {
+    {0,1},{1,2},{2,3},{3,0}, {4,5},{5,6},{6,7},{7,4}, {0,4},{1,5},{2,6},{3,7}
+};
+
+static int clampi(int v, int lo, int hi) { return v < lo ? lo : v > hi ? hi : v; }
+
+static float edge_fn(VcPickVertex a, VcPickVertex b, float px, float py) {
+    return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+}
+
+static void fill_quad(VcPickBuffer *pb, const VcPickVertex *q, unsigned char id) {
+    float minx = q[0].x, maxx = q[0].x, miny = q[0].y, maxy = q[0].y;
+    for (int i = 1; i < 4; i++) {
+        if (q[i].x < minx) minx = q[i].x;
+        if (q[i].x > maxx) maxx = q[i].x;
+        if (q[i].y < miny) miny = q[i].y;
+        if (q[i].y > maxy) maxy = q[i].y;
+    }
+    int x0 = clampi((int)minx - pb->x, 0, pb->width - 1);
+    int x1 = clampi((int)maxx + 1 - pb->x, 0, pb->width - 1);
+    int y0 = clampi((int)miny - pb->y, 0, pb->height - 1);
+    int y1 = clampi((int)maxy + 1 - pb->y, 0, pb->height - 1);
+
+    // Accept either winding; the projected face is convex
+    float area = edge_fn(q[0], q[1], q[2].x, q[2].y) + edge_fn(q[0], q[2], q[3].x, q[3].y);
+    float sign = area < 0 ? -1 : 1;
+    for (int y = y0; y <= y1; y++) for (int x = x0; x <= x1; x++) {
+        float px = pb->x + x + 0.5f, py = pb->y + y + 0.5f;
+        int inside = 1;
+        for (int i = 0; i < 4 && inside; i++)
+            inside = sign * edge_fn(q[i], q[(i + 1) % 4], px, py) >= 0;
+        if (inside) pb->ids[y * pb->width + x] = id;
+    }
+}
+
+static void fill_capsule(VcPickBuffer *pb, VcPickVertex a, VcPickVertex b, int r, unsigned char id) {
+    int x0 = clampi((int)(a.x < b.x ? a.x : b.x) - r - pb->x, 0, pb->width - 1);
+    int x1 = clampi((int)(a.x > b.x ? a.x : b.x) + r + 1 - pb->x, 0, pb->width - 1);
+    int y0 = clampi((int)(a.y < b.y ? a.y : b.y) - r - pb->y, 0, pb->height - 1);
+    int y1 = clampi((int)(a.y > b.y ? a.y : b.y) + r + 1 - pb->y, 0, pb->height - 1);
+    float dx = b.x - a.x, dy = b.y - a.y;
+    float len2 = dx*dx + dy*dy;
+    for (int y = y0; y <= y1; y++) for (int x = x0; x <= x1; x++) {
+        float px = pb->x + x + 0.5f - a.x, py = pb->y + y + 0.5f - a.y;
+        float t = len2 > 0 ? (px*dx + py*dy) / len2 : 0;
+        if (t < 0) t = 0; else if (t > 1) t = 1;
+        float ex = px - t*dx, ey = py - t*dy;
+        if (ex*ex + ey*ey <= (float)(r * r)) pb->ids[y * pb->width + x] = id;
+    }
+}
+
+void vc_pick_init(VcPickBuffer *pb, int edge_radius, int corner_radius) {
+    memset(pb, 0, sizeof(*pb));
+    pb->edge_radius = edge_radius;
+    pb->corner_radius = corner_radius;
+}
+
+void vc_pick_free(VcPickBuffer *pb) {
+    free(pb->ids);
+    pb->ids = NULL;
+    pb->valid = 0;
+}
+
+void vc_pick_resize(VcPickBuffer *pb, int x, int y, int width, int height) {
+    if (width * height != pb->width * pb->height || !pb->ids) {
+        free(pb->ids);
+        pb->ids = malloc(width * height);
+        if (!pb->ids) {
+            fprintf(stderr, "viewcube_pick: out of memory\n");
+            exit(1);
+        }
+    }
+    pb->x = x; pb->y = y;
+    pb->width = width; pb->height = height;
+    pb->valid = 0;
+}
+
+int vc_pick_stale(const VcPickBuffer *pb, double ax, double ay, double az) {
+    return !pb->valid || pb->ax != ax || pb->ay != ay || pb->az != az;
+}
+
+void vc_pick_render(VcPickBuffer *pb, const VcPickVertex v[8], double ax, double ay, double az) {
+    memset(pb->ids, VC_PICK_NONE, pb->width * pb->height);
+    memset(pb->edge_visible, 0, sizeof(pb->edge_visible));
+    memset(pb->corner_visible, 0, sizeof(pb->corner_visible));
+
+    // The cube is centred on the origin, so a face points at the viewer
+    // when its centre has negative depth.
+    for (int f = 0; f < 6; f++) {
+        const int *fv = vc_cube_faces[f];
+        float z = v[fv[0]].z + v[fv[1]].z + v[fv[2]].z + v[fv[3]].z;
+        pb->face_visible[f] = z < -1e-4f;
+        if (!pb->face_visible[f]) continue;
+        VcPickVertex q[4] = { v[fv[0]], v[fv[1]], v[fv[2]], v[fv[3]] };
+        fill_quad(pb, q, VC_PICK_FACE + f);
+        for (int i = 0; i < 4; i++) {
+            pb->corner_visible[fv[i]] = 1;
+            for (int e = 0; e < 12; e++) {
+                int a = vc_cube_edges[e][0], b = vc_cube_edges[e][1];
+                int c = fv[i], d = fv[(i + 1) % 4];
+                if ((a == c && b == d) || (a == d && b == c)) pb->edge_visible[e] = 1;
+            }
+        }
+    }
+    for (int e = 0; e < 12; e++)
+        if (pb->edge_visible[e])
+            fill_capsule(pb, v[vc_cube_edges[e][0]], v[vc_cube_edges[e][1]],
+                         pb->edge_radius, VC_PICK_EDGE + e);
+    for (int c = 0; c < 8; c++)
+        if (pb->corner_visible[c])
+            fill_capsule(pb, v[c], v[c], pb->corner_radius, VC_PICK_CORNER + c);
+
+    pb->ax = ax; pb->ay = ay; pb->az = az;
+    pb->valid = 1;
+}
+
+int vc_pick_lookup(const VcPickBuffer *pb, int x, int y) {
+    x -= pb->x; y -= pb->y;
+    if (!pb->valid || x < 0 || y < 0 || x >= pb->width || y >= pb->height)
+        return VC_PICK_NONE;
+    return pb->ids[y * pb->width + x];
+}
+
+void vc_pick_direction(int id, float dir[3]) {
+    dir[0] = dir[1] = dir[2] = 0;
+    if (VC_PICK_IS_FACE(id)) {
+        for (int i = 0; i < 4; i++)
+            for (int k = 0; k < 3; k++)
+                dir[k] += vc_cube_vertices[vc_cube_faces[id - VC_PICK_FACE][i]][k];
+    } else if (VC_PICK_IS_EDGE(id)) {
+        for (int i = 0; i < 2; i++)
+            for (int k = 0; k < 3; k++)
+                dir[k] += vc_cube_vertices[vc_cube_edges[id - VC_PICK_EDGE][i]][k];
+    } else if (VC_PICK_IS_CORNER(id)) {
+        for (int k = 0; k < 3; k++)
+            dir[k] = vc_cube_vertices[id - VC_PICK_CORNER][k];
+    }
+}
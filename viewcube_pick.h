@@ -0,0 +1,56 @@
+/* viewcube_pick.h - Item-ID buffer for ViewCube picking
+ *
+ * The cube's faces, edges and corners are rasterized into a small byte
+ * buffer covering the cube's screen region. Hover and click are then a
+ * single lookup. The buffer is only re-rendered when the view angles change.
+ *
+ * The cube is convex, so an item is occluded exactly when none of its
+ * faces point towards the viewer, who looks along +z from the -z side.
+ * Visible faces never overlap, so no depth buffer is needed. Corners are
+ * drawn over edges, and edges over faces.
+ */
+
+#ifndef VIEWCUBE_PICK_H
+#define VIEWCUBE_PICK_H
+
+// Item IDs: 0 is empty, then 6 faces, 12 edges and 8 corners
+#define VC_PICK_NONE   0
+#define VC_PICK_FACE   1
+#define VC_PICK_EDGE   (VC_PICK_FACE + 6)
+#define VC_PICK_CORNER (VC_PICK_EDGE + 12)
+
+#define VC_PICK_IS_FACE(id)   ((id) >= VC_PICK_FACE && (id) < VC_PICK_EDGE)
+#define VC_PICK_IS_EDGE(id)   ((id) >= VC_PICK_EDGE && (id) < VC_PICK_CORNER)
+#define VC_PICK_IS_CORNER(id) ((id) >= VC_PICK_CORNER && (id) < VC_PICK_CORNER + 8)
+
+// Shared cube topology, indexing the vertices
+//   {-1,-1,-1},{1,-1,-1},{1,1,-1},{-1,1,-1},{-1,-1,1},{1,-1,1},{1,1,1},{-1,1,1}
+extern const float vc_cube_vertices[8][3];
+extern const int vc_cube_faces[6][4];   // -z, +z, -x, +x, -y, +y
+extern const int vc_cube_edges[12][2];
+
+// A cube vertex after rotation: window pixel position and depth (-z faces the viewer)
+typedef struct { float x, y, z; } VcPickVertex;
+
+typedef struct {
+    int x, y, width, height;     // buffer region in window coordinates
+    int edge_radius, corner_radius;
+    unsigned char *ids;
+    int face_visible[6];
+    int edge_visible[12];
+    int corner_visible[8];
+    double ax, ay, az;           // view angles the buffer was rendered for
+    int valid;
+} VcPickBuffer;
+
+void vc_pick_init(VcPickBuffer *pb, int edge_radius, int corner_radius);
+void vc_pick_free(VcPickBuffer *pb);
+// Moves or resizes the buffer region and invalidates it
+void vc_pick_resize(VcPickBuffer *pb, int x, int y, int width, int height);
+int  vc_pick_stale(const VcPickBuffer *pb, double ax, double ay, double az);
+void vc_pick_render(VcPickBuffer *pb, const VcPickVertex v[8], double ax, double ay, double az);
+int  vc_pick_lookup(const VcPickBuffer *pb, int x, int y);
+// Model-space direction from the cube centre to the item (unnormalized)
+void vc_pick_direction(int id, float dir[3]);
+
+#endif
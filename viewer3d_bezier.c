@@ -6,6 +6,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include "tessellate.h"
+#include "viewcube_pick.h"
 
 #define WIDTH 800
 #define HEIGHT 600
@@ -20,21 +22,29 @@ int last_x = 0, last_y = 0;
 int rotating = 0, panning = 0;
 int inside_viewcube = 0;
 int viewcube_selected_face = -1;
+VcPickBuffer viewcube_pick;
+
+#define VIEWCUBE_SIZE 50
+#define VIEWCUBE_CX (WIDTH - VIEWCUBE_SIZE - 10)
+#define VIEWCUBE_CY (10 + VIEWCUBE_SIZE)
 
 // Animation step for snapping
 #define ANGLE_ANIM_STEP 0.05f
 
-typedef struct { float x, y, z; } Vec3;
 typedef struct { int x, y; } Vec2;
 
-float bernstein(int i, int n, float t);
-
-Vec3 bezier_ctrl[4][4] = {
+BezierPatch patches[] = {{{
   {{-1,-1,0},{-0.3,-1,1},{0.3,-1,-1},{1,-1,0}},
   {{-1,-0.3,1},{-0.3,-0.3,2},{0.3,-0.3,0},{1,-0.3,1}},
   {{-1,0.3,0},{-0.3,0.3,1},{0.3,0.3,-1},{1,0.3,0}},
   {{-1,1,0},{-0.3,1,1},{0.3,1,-1},{1,1,0}}
-};
+}}};
+int npatches = sizeof(patches) / sizeof(patches[0]);
+
+// Tessellated model, rebuilt only when the patches change
+TessContext tess;
+Vec3 *rotated = NULL;
+size_t rotated_cap = 0;
 
 Vec3 rotate_point(Vec3 v, float ax, float ay, float az) {
     float cx = cos(ax), sx = sin(ax);
@@ -74,23 +84,6 @@ float vec_dot(Vec3 a, Vec3 b) { return a.x*b.x + a.y*b.y + a.z*b.z; }
 Vec3 vec_add(Vec3 a, Vec3 b) { return (Vec3){a.x+b.x, a.y+b.y, a.z+b.z}; }
 Vec3 vec_scale(Vec3 v, float s) { return (Vec3){v.x*s, v.y*s, v.z*s}; }
 
-Vec3 bezier(float u, float v) {
-    Vec3 sum = {0};
-    for (int i = 0; i < 4; i++) for (int j = 0; j < 4; j++) {
-        float bu = bernstein(i, 3, u);
-        float bv = bernstein(j, 3, v);
-        sum.x += bu * bv * bezier_ctrl[i][j].x;
-        sum.y += bu * bv * bezier_ctrl[i][j].y;
-        sum.z += bu * bv * bezier_ctrl[i][j].z;
-    }
-    return sum;
-}
-
-float bernstein(int i, int n, float t) {
-    int C[4] = {1, 3, 3, 1};
-    return C[i] * pow(t, i) * pow(1 - t, n - i);
-}
-
 void put_pixel(XImage *img, int x, int y, int r, int g, int b) {
     if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) return;
     unsigned long pixel = (r << 16) | (g << 8) | b;
@@ -145,28 +138,28 @@ void draw_viewcube_labels(XImage *img, int cx, int cy, int size) {
 }
 
 void draw_viewcube(XImage *img) {
-    int size = 50;
-    int cx = WIDTH - size - 10;
-    int cy = 10 + size;
-    Vec3 corners[8] = {
-        {-1,-1,-1},{1,-1,-1},{1,1,-1},{-1,1,-1},
-        {-1,-1, 1},{1,-1, 1},{1,1, 1},{-1,1, 1}
-    };
+    int size = VIEWCUBE_SIZE;
+    int cx = VIEWCUBE_CX;
+    int cy = VIEWCUBE_CY;
     Vec2 screen[8];
+    VcPickVertex pv[8];
     for (int i = 0; i < 8; i++) {
-        Vec3 r = rotate_point(corners[i], angleX, angleY, angleZ);
+        Vec3 corner = { vc_cube_vertices[i][0], vc_cube_vertices[i][1], vc_cube_vertices[i][2] };
+        Vec3 r = rotate_point(corner, angleX, angleY, angleZ);
         screen[i].x = cx + (int)(r.x * size / 2);
         screen[i].y = cy - (int)(r.y * size / 2);
+        pv[i] = (VcPickVertex){ cx + r.x * size / 2, cy - r.y * size / 2, r.z };
     }
-    int edges[12][2] = {
-        {0,1},{1,2},{2,3},{3,0}, {4,5},{5,6},{6,7},{7,4},
-        {0,4},{1,5},{2,6},{3,7}
-    };
+    if (vc_pick_stale(&viewcube_pick, angleX, angleY, angleZ))
+        vc_pick_render(&viewcube_pick, pv, angleX, angleY, angleZ);
+    // Only what the ID buffer can pick is drawn
     for (int i = 0; i < 12; i++) {
-        draw_line(img, screen[edges[i][0]].x, screen[edges[i][0]].y,
-                       screen[edges[i][1]].x, screen[edges[i][1]].y, 200, 200, 200);
+        if (!viewcube_pick.edge_visible[i]) continue;
+        draw_line(img, screen[vc_cube_edges[i][0]].x, screen[vc_cube_edges[i][0]].y,
+                       screen[vc_cube_edges[i][1]].x, screen[vc_cube_edges[i][1]].y, 200, 200, 200);
     }
     for (int i = 0; i < 8; i++) {
+        if (!viewcube_pick.corner_visible[i]) continue;
         put_pixel(img, screen[i].x, screen[i].y, 255, 255, 255);
     }
     draw_viewcube_labels(img, cx, cy, size);
@@ -236,37 +229,31 @@ void key_handler(Widget w, XtPointer client_data, XEvent *event, Boolean *cont)
     }
 }*/
 
-void draw_uv_grid(XImage *img) {
-    for (int i = 0; i <= GRID; i++) {
-        float u = (float)i / GRID;
-        Vec3 prev = bezier(u, 0);
-        for (int j = 1; j <= GRID; j++) {
-            float v = (float)j / GRID;
-            Vec3 curr = bezier(u, v);
-            Vec3 p1 = rotate(prev);
-            Vec3 p2 = rotate(curr);
-            int x1 = WIDTH / 2 + (int)((p1.x + panX) * zoom * ZOOM);
-            int y1 = HEIGHT / 2 - (int)((p1.y + panY) * zoom * ZOOM);
-            int x2 = WIDTH / 2 + (int)((p2.x + panX) * zoom * ZOOM);
-            int y2 = HEIGHT / 2 - (int)((p2.y + panY) * zoom * ZOOM);
-            draw_line(img, x1, y1, x2, y2, 180, 180, 200);
-            prev = curr;
+void draw_uv_grid(XImage *img, const Vec3 *rot) {
+    int n = GRID + 1;
+    for (int p = 0; p < npatches; p++) {
+        const Vec3 *pv = rot + (size_t)p * n * n;
+        for (int i = 0; i <= GRID; i++) {
+            for (int j = 1; j <= GRID; j++) {
+                Vec3 p1 = pv[i * n + j - 1];
+                Vec3 p2 = pv[i * n + j];
+                int x1 = WIDTH / 2 + (int)((p1.x + panX) * zoom * ZOOM);
+                int y1 = HEIGHT / 2 - (int)((p1.y + panY) * zoom * ZOOM);
+                int x2 = WIDTH / 2 + (int)((p2.x + panX) * zoom * ZOOM);
+                int y2 = HEIGHT / 2 - (int)((p2.y + panY) * zoom * ZOOM);
+                draw_line(img, x1, y1, x2, y2, 180, 180, 200);
+            }
         }
-    }
-    for (int j = 0; j <= GRID; j++) {
-        float v = (float)j / GRID;
-        Vec3 prev = bezier(0, v);
-        for (int i = 1; i <= GRID; i++) {
-            float u = (float)i / GRID;
-            Vec3 curr = bezier(u, v);
-            Vec3 p1 = rotate(prev);
-            Vec3 p2 = rotate(curr);
-            int x1 = WIDTH / 2 + (int)((p1.x + panX) * zoom * ZOOM);
-            int y1 = HEIGHT / 2 - (int)((p1.y + panY) * zoom * ZOOM);
-            int x2 = WIDTH / 2 + (int)((p2.x + panX) * zoom * ZOOM);
-            int y2 = HEIGHT / 2 - (int)((p2.y + panY) * zoom * ZOOM);
-            draw_line(img, x1, y1, x2, y2, 180, 180, 200);
-            prev = curr;
+        for (int j = 0; j <= GRID; j++) {
+            for (int i = 1; i <= GRID; i++) {
+                Vec3 p1 = pv[(i - 1) * n + j];
+                Vec3 p2 = pv[i * n + j];
+                int x1 = WIDTH / 2 + (int)((p1.x + panX) * zoom * ZOOM);
+                int y1 = HEIGHT / 2 - (int)((p1.y + panY) * zoom * ZOOM);
+                int x2 = WIDTH / 2 + (int)((p2.x + panX) * zoom * ZOOM);
+                int y2 = HEIGHT / 2 - (int)((p2.y + panY) * zoom * ZOOM);
+                draw_line(img, x1, y1, x2, y2, 180, 180, 200);
+            }
         }
     }
 }
@@ -294,14 +281,31 @@ void draw_scene(Display *dpy, Window win, GC gc, Visual *visual, int depth) {
     memset(img->data, 0, WIDTH * HEIGHT * 4);
     Vec3 light = vec_normalize((Vec3){1, 1, -1});
 
-    for (int i = 0; i < GRID; i++) for (int j = 0; j < GRID; j++) {
-        float u = (float)i / GRID, v = (float)j / GRID;
-        float u1 = (float)(i+1) / GRID, v1 = (float)(j+1) / GRID;
+    if (tess.nverts > rotated_cap) {
+        Vec3 *grown = realloc(rotated, tess.nverts * sizeof(Vec3));
+        if (!grown) {
+            fprintf(stderr, "viewer3d_bezier: out of memory\n");
+            exit(1);
+        }
+        rotated = grown;
+        rotated_cap = tess.nverts;
+    }
+    // Rotate the basis once per frame instead of doing the trig per vertex
+    Vec3 ex = rotate((Vec3){1, 0, 0});
+    Vec3 ey = rotate((Vec3){0, 1, 0});
+    Vec3 ez = rotate((Vec3){0, 0, 1});
+    for (size_t k = 0; k < tess.nverts; k++) {
+        Vec3 p = tess.verts[k];
+        rotated[k] = vec_add(vec_add(vec_scale(ex, p.x), vec_scale(ey, p.y)), vec_scale(ez, p.z));
+    }
 
-        Vec3 p00 = rotate(bezier(u, v));
-        Vec3 p10 = rotate(bezier(u1, v));
-        Vec3 p01 = rotate(bezier(u, v1));
-        Vec3 p11 = rotate(bezier(u1, v1));
+    // Each quad is stored as (p00, p10, p11), (p00, p11, p01)
+    for (size_t k = 0; k < tess.nindices; k += 6) {
+        const unsigned int *q = tess.indices + k;
+        Vec3 p00 = rotated[q[0]];
+        Vec3 p10 = rotated[q[1]];
+        Vec3 p11 = rotated[q[2]];
+        Vec3 p01 = rotated[q[5]];
 
         Vec3 n00 = vec_normalize(vec_cross(vec_sub(p10, p00), vec_sub(p01, p00)));
         Vec3 n10 = vec_normalize(vec_cross(vec_sub(p11, p10), vec_sub(p00, p10)));
@@ -318,7 +322,7 @@ void draw_scene(Display *dpy, Window win, GC gc, Visual *visual, int depth) {
     }
 
     draw_viewcube(img);
-    draw_uv_grid(img);
+    draw_uv_grid(img, rotated);
     XPutImage(dpy, win, gc, img, 0, 0, 0, 0, WIDTH, HEIGHT);
     XDestroyImage(img);
 }
@@ -360,21 +364,17 @@ void button_cb(Widget w, XtPointer d, XEvent *e, Boolean *c) {
     if (ev->type == ButtonPress) {
         last_x = ev->x;
         last_y = ev->y;
-        inside_viewcube = (ev->x > WIDTH - 70 && ev->y < 70);
+        int id = vc_pick_lookup(&viewcube_pick, ev->x, ev->y);
+        inside_viewcube = (id != VC_PICK_NONE);
 
         if (inside_viewcube) {
-            int rel_x = ev->x - (WIDTH - 40);
-            int rel_y = ev->y - 10;
-            if (rel_x < 20 && rel_y < 20) {
-                // top
-                angleX = -1.57f; angleY = 0; angleZ = 0;
-            } else if (rel_x > 20 && rel_y > 20) {
-                // bottom right
-                angleX = 1.57f; angleY = 0; angleZ = 0;
-            } else {
-                // front
-                angleX = 0; angleY = 0; angleZ = 0;
-            }
+            // Turn the picked face, edge or corner towards the viewer (-z)
+            float dir[3];
+            vc_pick_direction(id, dir);
+            // Straight up or down: no yaw (atan2(0, -0) would give pi)
+            angleY = (dir[0] == 0 && dir[2] == 0) ? 0 : atan2(dir[0], -dir[2]);
+            angleX = atan2(-dir[1], sqrt(dir[0]*dir[0] + dir[2]*dir[2]));
+            angleZ = 0;
             redisplay(w);
             return;
         }
@@ -402,6 +402,11 @@ void expose_cb(Widget w, XtPointer d, XEvent *e, Boolean *c) {
 
 int main(int argc, char **argv) {
     XtAppContext app;
+    tess_init(&tess, GRID, 0);
+    tess_build(&tess, patches, npatches);
+    vc_pick_init(&viewcube_pick, 3, 5);
+    vc_pick_resize(&viewcube_pick, VIEWCUBE_CX - VIEWCUBE_SIZE, VIEWCUBE_CY - VIEWCUBE_SIZE,
+                   2 * VIEWCUBE_SIZE, 2 * VIEWCUBE_SIZE);
     Widget top = XtVaAppInitialize(&app, "Bezier3D", NULL, 0, &argc, argv, NULL, NULL);
     Widget draw = XtVaCreateManagedWidget("draw", xmDrawingAreaWidgetClass, top,
         XmNwidth, WIDTH, XmNheight, HEIGHT, NULL);